@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""Merge and compare the results of the ITHACA-FV benchmarks.
+
+merge:   collects the benchmark.json files written by ITHACAbenchmark in
+         the cube cases into one report, together with the hardware and
+         software information needed to interpret the timings.
+compare: compares a report with a stored baseline kernel by kernel, using
+         the median times, and exits with status 1 if any kernel is slower
+         than the baseline by more than the threshold.
+"""
+
+import argparse
+import datetime
+import json
+import os
+import platform
+import subprocess
+import sys
+
+
+def cpu_model():
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.startswith("model name"):
+                    return line.split(":", 1)[1].strip()
+    except OSError:
+        pass
+    return platform.processor()
+
+
+def memory_gb():
+    try:
+        with open("/proc/meminfo") as f:
+            for line in f:
+                if line.startswith("MemTotal"):
+                    return round(int(line.split()[1]) / 1024**2, 1)
+    except OSError:
+        pass
+    return None
+
+
+def git_commit():
+    try:
+        out = subprocess.run(["git", "rev-parse", "HEAD"], capture_output=True,
+                             text=True, cwd=os.path.dirname(os.path.abspath(__file__)))
+        return out.stdout.strip() if out.returncode == 0 else None
+    except OSError:
+        return None
+
+
+def merge(args):
+    cases = []
+    for name in args.results:
+        with open(name) as f:
+            cases.append(json.load(f))
+    cases.sort(key=lambda c: c["nCells"])
+    report = {
+        "date": datetime.datetime.now(datetime.timezone.utc).isoformat(),
+        "commit": git_commit(),
+        "hardware": {
+            "cpu": cpu_model(),
+            "logicalCores": os.cpu_count(),
+            "memoryGB": memory_gb(),
+            "machine": platform.machine(),
+        },
+        "software": {
+            "os": platform.platform(),
+            "openfoam": os.environ.get("WM_PROJECT_VERSION"),
+            "compiler": os.environ.get("WM_COMPILER"),
+            "ompThreads": os.environ.get("OMP_NUM_THREADS"),
+        },
+        "cases": cases,
+    }
+    with open(args.output, "w") as f:
+        json.dump(report, f, indent=4)
+    print("Benchmark report written to " + args.output)
+    return 0
+
+
+def compare(args):
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    with open(args.current) as f:
+        current = json.load(f)
+    if baseline.get("hardware", {}).get("cpu") != current.get("hardware", {}).get("cpu"):
+        print("Warning: the baseline was recorded on a different CPU")
+    reference = {c["nCells"]: c["kernels"] for c in baseline["cases"]}
+    regressions = 0
+    print("{:>10} {:<24} {:>12} {:>12} {:>8}".format(
+        "nCells", "kernel", "baseline [s]", "current [s]", "ratio"))
+    for case in current["cases"]:
+        kernels = reference.get(case["nCells"])
+        if kernels is None:
+            print("{:>10} not in the baseline".format(case["nCells"]))
+            continue
+        for name, timing in case["kernels"].items():
+            if name not in kernels:
+                continue
+            old = kernels[name]["median"]
+            new = timing["median"]
+            ratio = new / old if old > 0 else float("inf")
+            flag = ""
+            if ratio > 1 + args.threshold:
+                flag = "  SLOWER"
+                regressions += 1
+            elif ratio < 1 - args.threshold:
+                flag = "  faster"
+            print("{:>10} {:<24} {:>12.4g} {:>12.4g} {:>8.3f}{}".format(
+                case["nCells"], name, old, new, ratio, flag))
+    if regressions:
+        print("{} kernel(s) slower than the baseline by more than {:.0%}".format(
+            regressions, args.threshold))
+        return 1
+    print("No regression above {:.0%}".format(args.threshold))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+    p = sub.add_parser("merge", help="merge the results of the cube cases")
+    p.add_argument("results", nargs="+", help="benchmark.json files")
+    p.add_argument("-o", "--output", default="results.json")
+    p.set_defaults(func=merge)
+    p = sub.add_parser("compare", help="compare a report with a baseline")
+    p.add_argument("baseline")
+    p.add_argument("current")
+    p.add_argument("-t", "--threshold", type=float, default=0.1,
+                   help="relative slowdown reported as a regression")
+    p.set_defaults(func=compare)
+    args = parser.parse_args()
+    return args.func(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
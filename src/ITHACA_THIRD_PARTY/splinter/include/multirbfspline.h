@@ -0,0 +1,76 @@
+/*
+ * This file is part of the Multivariate Splines library.
+ * Copyright (C) 2012 Bjarne Grimstad (bjarne.grimstad@gmail.com)
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+
+#ifndef MS_MULTIRBFSPLINE_H
+#define MS_MULTIRBFSPLINE_H
+
+#include <rbfspline.h>
+#include <memory>
+
+namespace SPLINTER
+{
+
+/*
+ * Vector-valued radial basis function spline.
+ * All the outputs share the same samples and the same kernel, therefore the
+ * (numSamples x numSamples) kernel matrix is assembled and factorised only once
+ * and the weights of every output are computed as multiple right-hand sides.
+ * The evaluation computes the kernel row once and returns all the outputs
+ * with a single matrix-vector product.
+ */
+class MultiRBFSpline
+{
+public:
+
+    /*
+     * Fit the spline.
+     * X contains one sample per row (numSamples x numVariables),
+     * Y contains the corresponding outputs (numSamples x numOutputs).
+     */
+    MultiRBFSpline(const DenseMatrix& X, const DenseMatrix& Y,
+                   RadialBasisFunctionType type, double e = 1.0);
+
+    /*
+     * Build the spline from precomputed weights (numSamples x numOutputs),
+     * e.g. read back from disk, without refactorising the kernel matrix.
+     */
+    MultiRBFSpline(const DenseMatrix& X, RadialBasisFunctionType type,
+                   const DenseMatrix& w, double e = 1.0);
+
+    // Returns all the outputs at x
+    DenseVector eval(const DenseVector& x) const;
+
+    // Writes all the outputs at x into y, y is resized if needed
+    void eval(const DenseVector& x, DenseVector& y) const;
+
+    // Writes all the outputs at x, an array of getNumVariables() values, into
+    // y, which must already hold getNumOutputs() entries
+    void eval(const double* x, DenseVector& y) const;
+
+    unsigned int getNumVariables() const { return dim; }
+    unsigned int getNumOutputs() const { return weights.cols(); }
+    unsigned int getNumSamples() const { return numSamples; }
+
+    // Weights (numSamples x numOutputs), one column per output
+    DenseMatrix weights;
+
+private:
+
+    // Samples packed row-wise (numSamples x numVariables)
+    DenseMatrix points;
+    unsigned int dim, numSamples;
+
+    RadialBasisFunctionType type;
+    std::shared_ptr<RadialBasisFunction> fn;
+};
+
+} // namespace SPLINTER
+
+#endif // MS_MULTIRBFSPLINE_H
@@ -14,6 +14,8 @@
 #include <datatable.h>
 #include <spline.h>
 #include <memory>
+#include <limits>
+#include <algorithm>
 
 namespace SPLINTER
 {
@@ -57,6 +59,12 @@ public:
     {
         return (r<=0.0) ? 0.0 : r*(2*std::log(r) + 1);
     }
+    template<class Derived>
+    auto evalArray(const Eigen::ArrayBase<Derived>& r) const
+    {
+        // r*r*log(r) vanishes at r = 0, the clamp only avoids log(0)
+        return r.square()*r.max(std::numeric_limits<double>::min()).log();
+    }
 };
 
 class Multiquadric : public RadialBasisFunction
@@ -70,6 +78,11 @@ public:
     {
         return e*e*r/std::sqrt(1 + e*e*r*r);
     }
+    template<class Derived>
+    auto evalArray(const Eigen::ArrayBase<Derived>& r) const
+    {
+        return (1.0 + e*e*r.square()).sqrt();
+    }
 };
 
 class InverseMultiquadric : public RadialBasisFunction
@@ -83,6 +96,11 @@ public:
     {
         return -e*e*r/(std::sqrt(1 + e*e*r*r)*(1 + e*e*r*r));
     }
+    template<class Derived>
+    auto evalArray(const Eigen::ArrayBase<Derived>& r) const
+    {
+        return (1.0 + e*e*r.square()).rsqrt();
+    }
 };
 
 class InverseQuadric : public RadialBasisFunction
@@ -96,6 +114,11 @@ public:
     {
         return -2*e*e*r/((1 + e*e*r*r)*(1 + e*e*r*r));
     }
+    template<class Derived>
+    auto evalArray(const Eigen::ArrayBase<Derived>& r) const
+    {
+        return (1.0 + e*e*r.square()).inverse();
+    }
 };
 
 class Gaussian : public RadialBasisFunction
@@ -109,6 +132,11 @@ public:
     {
         return -2*e*e*r*std::exp(-e*e*r*r);
     }
+    template<class Derived>
+    auto evalArray(const Eigen::ArrayBase<Derived>& r) const
+    {
+        return (-e*e*r.square()).exp();
+    }
 };
 
 class Linear : public RadialBasisFunction
@@ -122,6 +150,11 @@ public:
     {
         return 1.0;
     }
+    template<class Derived>
+    auto evalArray(const Eigen::ArrayBase<Derived>& r) const
+    {
+        return r*1.0;
+    }
 };
 
 class Cubic : public RadialBasisFunction
@@ -135,6 +168,11 @@ public:
     {
         return 3*r*r;
     }
+    template<class Derived>
+    auto evalArray(const Eigen::ArrayBase<Derived>& r) const
+    {
+        return r.cube();
+    }
 };
 
 class Quintic : public RadialBasisFunction
@@ -148,8 +186,82 @@ public:
     {
         return 5*r*r*r*r;
     }
+    template<class Derived>
+    auto evalArray(const Eigen::ArrayBase<Derived>& r) const
+    {
+        return r.square().square()*r;
+    }
 };
 
+/*
+ * Returns the radial basis function of the given type with shape parameter e.
+ */
+std::shared_ptr<RadialBasisFunction> makeRadialBasisFunction(
+    RadialBasisFunctionType type, double e = 1.0);
+
+/*
+ * Calls f with fn cast to the concrete kernel class selected by type, so that
+ * the kernel evaluation inside f is resolved at compile time. fn must have
+ * been created by makeRadialBasisFunction with the same type.
+ */
+template<class F>
+inline auto visitRadialBasisFunction(RadialBasisFunctionType type,
+                                     const RadialBasisFunction& fn, F&& f)
+{
+    switch (type)
+    {
+        case RadialBasisFunctionType::MULTIQUADRIC:
+            return f(static_cast<const Multiquadric&>(fn));
+        case RadialBasisFunctionType::INVERSE_QUADRIC:
+            return f(static_cast<const InverseQuadric&>(fn));
+        case RadialBasisFunctionType::INVERSE_MULTIQUADRIC:
+            return f(static_cast<const InverseMultiquadric&>(fn));
+        case RadialBasisFunctionType::GAUSSIAN:
+            return f(static_cast<const Gaussian&>(fn));
+        case RadialBasisFunctionType::LINEAR:
+            return f(static_cast<const Linear&>(fn));
+        case RadialBasisFunctionType::CUBIC:
+            return f(static_cast<const Cubic&>(fn));
+        case RadialBasisFunctionType::QUINTIC:
+            return f(static_cast<const Quintic&>(fn));
+        default:
+            return f(static_cast<const ThinPlateSpline&>(fn));
+    }
+}
+
+/*
+ * Evaluates the kernel k between the point x (dim values) and the samples
+ * stored row-wise in the packed (numSamples x dim) matrix points, one block
+ * of samples at a time. For every block op(start, phi) is called, phi holding
+ * the kernel values of samples start, ..., start + phi.size() - 1.
+ * The squared distances are accumulated one coordinate at a time over
+ * contiguous columns, so the loop vectorises, and the block buffer lives on
+ * the stack, so no heap allocation takes place.
+ */
+template<class Kernel, class Op>
+inline void evalKernelBlocks(const Kernel& k, const DenseMatrix& points,
+                             const double* x, Op&& op)
+{
+    constexpr Eigen::Index blockSize = 128;
+    Eigen::Array<double, blockSize, 1> buffer;
+    const Eigen::Index numSamples = points.rows();
+
+    for (Eigen::Index start = 0; start < numSamples; start += blockSize)
+    {
+        const Eigen::Index n = std::min(blockSize, numSamples - start);
+        auto r = buffer.head(n);
+        r.setZero();
+
+        for (Eigen::Index d = 0; d < points.cols(); d++)
+        {
+            r += (points.col(d).segment(start, n).array() - x[d]).square();
+        }
+
+        r = k.evalArray(r.sqrt());
+        op(start, r);
+    }
+}
+
 /*
  * Class for radial basis function splines.
  * The RBF splines support scattered sampling, but their construction require
@@ -166,8 +278,14 @@ public:
 
     virtual RBFSpline* clone() const { return new RBFSpline(*this); }
 
-    double eval(DenseVector x) const;
-    double eval(std::vector<double> x) const;
+    double eval(const DenseVector& x) const;
+    double eval(const std::vector<double>& x) const;
+
+    // Evaluates the spline at x, an array of getNumVariables() values
+    double eval(const double* x) const;
+
+    // Evaluates the spline at every row of X (numPoints x numVariables)
+    DenseVector evalBatch(const DenseMatrix& X) const;
 
     DenseMatrix evalJacobian(DenseVector x) const { return DenseMatrix(); } // TODO: implement via RBF_fn
     DenseMatrix evalHessian(DenseVector x) const { return DenseMatrix(); } // TODO: implement via RBF_fn
@@ -179,18 +297,20 @@ public:
 
 private:
 
-    const DataTable samples;
+    // Samples packed row-wise (numSamples x dim), in the DataTable order
+    DenseMatrix points;
     bool normalized, precondition;
     unsigned int dim, numSamples;
 
+    RadialBasisFunctionType type;
     std::shared_ptr<RadialBasisFunction> fn;
 
+    void packSamples(const DataTable& samples);
 
-    DenseMatrix computePreconditionMatrix() const;
+    template<class Kernel>
+    double evalPacked(const Kernel& k, const double* x) const;
 
-    double dist(std::vector<double> x, std::vector<double> y) const;
-    double dist(DataPoint x, DataPoint y) const;
-    bool dist_sort(DataPoint x, DataPoint y) const;
+    DenseMatrix computePreconditionMatrix() const;
 
 };
 
@@ -28,7 +28,7 @@ public:
     /*
      * Returns the spline value at x
      */
-    virtual double eval(DenseVector x) const = 0;
+    virtual double eval(const DenseVector& x) const = 0;
 
     /*
      * Returns the (1 x numVariables) Jacobian evaluated at x